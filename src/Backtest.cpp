@@ -0,0 +1,170 @@
+#include "Backtest.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<OrderEvent> load_order_flow(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Could not open order flow file: " + path);
+    }
+
+    std::vector<OrderEvent> events;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string type, side;
+        OrderEvent ev{};
+        char comma;
+        bool ok = static_cast<bool>(std::getline(fields, type, ','));
+
+        if (ok && type == "A") {
+            ev.type = EventType::Add;
+            ok = static_cast<bool>(fields >> ev.order_id >> comma >> ev.price >> comma
+                                          >> ev.quantity >> comma >> side);
+            if (ok && side == "B") ev.side = OrderSide::Buy;
+            else if (ok && side == "S") ev.side = OrderSide::Sell;
+            else ok = false;
+            ok = ok && LimitOrderBook::is_valid_price(ev.price);
+        } else if (ok && type == "C") {
+            ev.type = EventType::Cancel;
+            ok = static_cast<bool>(fields >> ev.order_id);
+        } else if (ok && type == "M") {
+            ev.type = EventType::Modify;
+            ok = static_cast<bool>(fields >> ev.order_id >> comma >> ev.quantity);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            throw std::runtime_error("Malformed order flow at " + path + ":" +
+                                     std::to_string(line_no) + ": " + line);
+        }
+        events.push_back(ev);
+    }
+    return events;
+}
+
+void save_order_flow(const std::string& path, const std::vector<OrderEvent>& events) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Could not open order flow file for writing: " + path);
+    }
+
+    for (const auto& ev : events) {
+        out << format_event(ev) << '\n';
+    }
+}
+
+std::string format_event(const OrderEvent& event) {
+    switch (event.type) {
+        case EventType::Add:
+            return "A," + std::to_string(event.order_id) + "," + std::to_string(event.price) + "," +
+                   std::to_string(event.quantity) + "," + (event.side == OrderSide::Buy ? "B" : "S");
+        case EventType::Cancel:
+            return "C," + std::to_string(event.order_id);
+        case EventType::Modify:
+            return "M," + std::to_string(event.order_id) + "," + std::to_string(event.quantity);
+    }
+    return "?";
+}
+
+std::vector<OrderEvent> generate_order_flow(size_t num_events, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int64_t> price_dist(90, 110);
+    std::uniform_int_distribution<int32_t> qty_dist(1, 200);
+    std::uniform_int_distribution<int> side_dist(0, 1);
+    std::uniform_int_distribution<int> op_dist(0, 8); // 0–6 = add, 7 = cancel, 8 = modify
+
+    std::vector<OrderEvent> events;
+    events.reserve(num_events);
+    std::vector<int64_t> active_ids;
+    int64_t next_order_id = 1;
+
+    while (events.size() < num_events) {
+        int op = op_dist(rng);
+
+        if (op <= 6 || active_ids.empty()) {
+            int64_t id = next_order_id++;
+            OrderSide side = side_dist(rng) == 0 ? OrderSide::Buy : OrderSide::Sell;
+            events.push_back({EventType::Add, id, price_dist(rng), qty_dist(rng), side});
+            active_ids.push_back(id);
+        } else if (op == 7) {
+            // ids may already have been filled; the book ignores unknown ids
+            size_t idx = rng() % active_ids.size();
+            events.push_back({EventType::Cancel, active_ids[idx], 0, 0, OrderSide::Buy});
+            active_ids[idx] = active_ids.back();
+            active_ids.pop_back();
+        } else {
+            size_t idx = rng() % active_ids.size();
+            events.push_back({EventType::Modify, active_ids[idx], 0, qty_dist(rng), OrderSide::Buy});
+        }
+    }
+    return events;
+}
+
+void apply_event(LimitOrderBook& lob, const OrderEvent& event) {
+    switch (event.type) {
+        case EventType::Add:
+            lob.process_order(event.order_id, event.price, event.quantity, event.side);
+            break;
+        case EventType::Cancel:
+            lob.cancel_order(event.order_id);
+            break;
+        case EventType::Modify:
+            lob.modify_order(event.order_id, event.quantity);
+            break;
+    }
+}
+
+BacktestReport BacktestRunner::run(const std::vector<OrderEvent>& events,
+                                   const std::vector<BacktestVariant>& variants) const {
+    BacktestReport report;
+    report.num_threads = num_threads;
+    report.runs.resize(variants.size());
+
+    WorkStealingPool pool(num_threads);
+    // Created lazily by the worker that uses it so the pages are first touched
+    // (and therefore placed) on that worker's core
+    std::vector<std::unique_ptr<MemoryPool<Order>>> worker_pools(num_threads);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    pool.run(variants.size(), [&](size_t worker, size_t run_idx) {
+        if (!worker_pools[worker]) {
+            worker_pools[worker] = std::make_unique<MemoryPool<Order>>(pool_size);
+        }
+        const auto& variant = variants[run_idx];
+        auto run_start = std::chrono::high_resolution_clock::now();
+
+        LimitOrderBook lob(*worker_pools[worker]);
+        for (size_t i = 0; i < events.size(); i++) {
+            apply_event(lob, events[i]);
+            if (variant.on_event) variant.on_event(lob, events[i], i);
+        }
+
+        auto run_end = std::chrono::high_resolution_clock::now();
+        auto& result = report.runs[run_idx];
+        result.name = variant.name;
+        result.fills = lob.get_fill_stats();
+        result.resting_orders = lob.resting_order_count();
+        result.state_hash = lob.get_state_hash();
+        result.elapsed_ms = std::chrono::duration<double, std::milli>(run_end - run_start).count();
+        result.worker = worker;
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    report.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    report.runs_per_sec = report.elapsed_ms > 0.0
+        ? (variants.size() / report.elapsed_ms) * 1000.0
+        : 0.0;
+    return report;
+}
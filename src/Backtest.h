@@ -0,0 +1,83 @@
+#ifndef ORDERBOOK_BACKTEST_H
+#define ORDERBOOK_BACKTEST_H
+
+#include "LimitOrderBook.h"
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class EventType {
+    Add,
+    Cancel,
+    Modify
+};
+
+// One message of recorded order flow
+struct OrderEvent {
+    EventType type;
+    int64_t order_id;
+    int64_t price;      // Add only
+    int32_t quantity;   // Add: order size, Modify: new size
+    OrderSide side;     // Add only
+};
+
+// Order-flow files are CSV, one event per line:
+//   A,<order_id>,<price>,<quantity>,<B|S>
+//   C,<order_id>
+//   M,<order_id>,<new_quantity>
+// Blank lines and lines starting with '#' are skipped. Adds priced outside the
+// book's ladder are rejected as malformed.
+std::vector<OrderEvent> load_order_flow(const std::string& path);
+void save_order_flow(const std::string& path, const std::vector<OrderEvent>& events);
+
+// Formats a single event in order-flow file syntax, e.g. "A,42,101,50,B"
+std::string format_event(const OrderEvent& event);
+
+// Synthetic flow with the same op mix as the randomized stress test
+std::vector<OrderEvent> generate_order_flow(size_t num_events, uint32_t seed = 42);
+
+void apply_event(LimitOrderBook& lob, const OrderEvent& event);
+
+// One strategy/configuration to evaluate against the shared order flow.
+// on_event (optional) runs after each replayed event and may inspect the book or
+// submit its own orders. It is called concurrently for different runs, so it
+// must not mutate shared state - derive anything per-run from event_idx.
+struct BacktestVariant {
+    std::string name;
+    std::function<void(LimitOrderBook&, const OrderEvent&, size_t event_idx)> on_event;
+};
+
+struct RunResult {
+    std::string name;
+    FillStats fills;
+    size_t resting_orders = 0;  // orders left in the book after the last event
+    uint64_t state_hash = 0;    // LimitOrderBook::get_state_hash() after the last event
+    double elapsed_ms = 0.0;
+    size_t worker = 0;          // worker thread that executed the run
+};
+
+struct BacktestReport {
+    std::vector<RunResult> runs;    // same order as the variants passed in
+    size_t num_threads = 0;
+    double elapsed_ms = 0.0;
+    double runs_per_sec = 0.0;
+};
+
+// Replays one read-only event stream against many independent books in parallel.
+// Each worker owns a MemoryPool that is reused by every book it runs, so there is
+// no allocator traffic shared between cores.
+class BacktestRunner {
+private:
+    size_t num_threads;
+    size_t pool_size;
+public:
+    explicit BacktestRunner(size_t num_threads = std::thread::hardware_concurrency(),
+                            size_t pool_size = 1'000'000)
+        : num_threads(num_threads == 0 ? 1 : num_threads), pool_size(pool_size) {}
+
+    BacktestReport run(const std::vector<OrderEvent>& events,
+                       const std::vector<BacktestVariant>& variants) const;
+};
+
+#endif // ORDERBOOK_BACKTEST_H
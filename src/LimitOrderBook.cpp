@@ -1,8 +1,33 @@
 #include "LimitOrderBook.h"
 #include <iostream>
 
+LimitOrderBook::~LimitOrderBook() {
+    // An owned pool dies with the book; a borrowed one outlives it and must
+    // get its slots back for the next book
+    if (order_pool == &owned_pool) return;
+    // Walk the levels rather than orders_by_id: a reused order id overwrites its
+    // map entry, but the earlier order is still resting and still owns a slot
+    for (const auto* active : {&active_bids, &active_asks}) {
+        for (size_t idx : *active) {
+            for (Order* order_ptr : price_levels[idx].orders) {
+                order_pool->deallocate(order_ptr);
+            }
+        }
+    }
+}
+
+size_t LimitOrderBook::resting_order_count() const {
+    size_t count = 0;
+    for (const auto* active : {&active_bids, &active_asks}) {
+        for (size_t idx : *active) count += price_levels[idx].orders.size();
+    }
+    return count;
+}
+
 void LimitOrderBook::process_order(int64_t order_id, int64_t price, int32_t quantity, OrderSide side) {
-    Order* new_order_ptr = order_pool.allocate();
+    if (!is_valid_price(price)) return;
+
+    Order* new_order_ptr = order_pool->allocate();
     *new_order_ptr = Order{order_id, price, quantity, side};
     orders_by_id[order_id] = new_order_ptr;
     
@@ -14,7 +39,7 @@ void LimitOrderBook::process_order(int64_t order_id, int64_t price, int32_t quan
         insert_order(new_order_ptr);
     } else {
         orders_by_id.erase(order_id);
-        order_pool.deallocate(new_order_ptr);
+        order_pool->deallocate(new_order_ptr);
     }
 }
 
@@ -34,15 +59,17 @@ void LimitOrderBook::match(Order* incoming) {
                 if (resting->side != OrderSide::Sell) break;
 
                 int32_t trade_qty = std::min(incoming->quantity, resting->quantity);
+                record_fill(incoming, resting, trade_qty);
                 incoming->quantity -= trade_qty;
                 resting->quantity -= trade_qty;
                 level.total_quantity -= trade_qty;
 
                 if (resting->quantity == 0) {
                     orders_by_id.erase(resting->order_id);
-                    order_pool.deallocate(resting);
-                    it = orders_vec.erase(it);
+                    it = unlink_order(orders_vec, it);
+                    order_pool->deallocate(resting);
                 } else {
+                    hash_add(resting);
                     ++it;
                 }
             }
@@ -66,15 +93,17 @@ void LimitOrderBook::match(Order* incoming) {
                 if (resting->side != OrderSide::Buy) break;
 
                 int32_t trade_qty = std::min(incoming->quantity, resting->quantity);
+                record_fill(incoming, resting, trade_qty);
                 incoming->quantity -= trade_qty;
                 resting->quantity -= trade_qty;
                 level.total_quantity -= trade_qty;
 
                 if (resting->quantity == 0) {
                     orders_by_id.erase(resting->order_id);
-                    order_pool.deallocate(resting);
-                    it = orders_vec.erase(it);
+                    it = unlink_order(orders_vec, it);
+                    order_pool->deallocate(resting);
                 } else {
+                    hash_add(resting);
                     ++it;
                 }
             }
@@ -99,8 +128,10 @@ void LimitOrderBook::insert_order(Order* incoming) {
         else active_asks.insert(idx);
     }
 
+    book_hash += link_hash(level.orders.empty() ? nullptr : level.orders.back(), incoming);
     level.orders.push_back(incoming);
     level.total_quantity += incoming->quantity;
+    hash_add(incoming);
 }
 
 void LimitOrderBook::cancel_order(int64_t order_id) {
@@ -114,9 +145,10 @@ void LimitOrderBook::cancel_order(int64_t order_id) {
     level.total_quantity -= order_ptr->quantity;
 
     auto& orders_vec = level.orders;
+    // Match by pointer: a reused id can leave an older order with the same id queued here
     for (size_t i = 0; i < orders_vec.size(); ++i) {
-        if (orders_vec[i]->order_id == order_id) {
-            orders_vec.erase(orders_vec.begin() + i);
+        if (orders_vec[i] == order_ptr) {
+            unlink_order(orders_vec, orders_vec.begin() + i);
             break;
         }
     }
@@ -126,8 +158,9 @@ void LimitOrderBook::cancel_order(int64_t order_id) {
         else active_asks.erase(idx);
     }
 
+    hash_remove(order_ptr);
     orders_by_id.erase(it);
-    order_pool.deallocate(order_ptr);
+    order_pool->deallocate(order_ptr);
 }
 
 void LimitOrderBook::modify_order(int64_t order_id, int32_t new_quantity) {
@@ -145,8 +178,75 @@ void LimitOrderBook::modify_order(int64_t order_id, int32_t new_quantity) {
 
     auto& order_ptr = order_by_id_it->second;
     auto diff = new_quantity - order_ptr->quantity;
+    hash_remove(order_ptr);
     order_ptr->quantity = new_quantity;
+    hash_add(order_ptr);
 
     size_t idx = price_to_index(order_ptr->price);
     price_levels[idx].total_quantity += diff;
+}
+
+BookMemoryReport LimitOrderBook::memory_usage() const {
+    BookMemoryReport report;
+    report.order_pool = order_pool->memory_usage();
+
+    report.price_levels.live_bytes = price_levels.size() * sizeof(PriceLevel);
+    report.price_levels.reserved_bytes = price_levels.capacity() * sizeof(PriceLevel);
+    for (const auto& level : price_levels) {
+        report.price_levels.live_bytes += level.orders.size() * sizeof(Order*);
+        report.price_levels.reserved_bytes += level.orders.capacity() * sizeof(Order*);
+    }
+
+    // Node layouts are implementation-defined: assume one link per hash node and
+    // parent/left/right/colour per tree node, ignoring allocator overhead
+    constexpr size_t index_node = sizeof(void*) + sizeof(std::pair<const int64_t, Order*>);
+    constexpr size_t level_node = 4 * sizeof(void*) + sizeof(size_t);
+    size_t index_nodes = orders_by_id.size() * index_node;
+    report.order_index.live_bytes = index_nodes;
+    report.order_index.reserved_bytes = index_nodes + orders_by_id.bucket_count() * sizeof(void*);
+
+    size_t active_nodes = (active_bids.size() + active_asks.size()) * level_node;
+    report.active_levels.live_bytes = active_nodes;
+    report.active_levels.reserved_bytes = active_nodes;
+    return report;
+}
+
+size_t LimitOrderBook::compact(const CompactionBudget& budget) {
+    size_t released = 0;
+
+    for (size_t n = 0; n < budget.max_levels && n < price_levels.size(); n++) {
+        auto& orders_vec = price_levels[compact_cursor].orders;
+        compact_cursor = (compact_cursor + 1) % price_levels.size();
+
+        size_t capacity = orders_vec.capacity();
+        if (orders_vec.empty()) {
+            if (capacity == 0) continue;
+            std::vector<Order*>().swap(orders_vec);
+        } else if (capacity >= 4 * orders_vec.size() && capacity > 16) {
+            // Keep 2x headroom so a level that refills doesn't immediately regrow
+            std::vector<Order*> trimmed;
+            trimmed.reserve(2 * orders_vec.size());
+            trimmed.assign(orders_vec.begin(), orders_vec.end());
+            orders_vec.swap(trimmed);
+        } else {
+            continue;
+        }
+        released += (capacity - orders_vec.capacity()) * sizeof(Order*);
+    }
+
+    released += order_pool->release_idle_chunks(budget.max_pool_chunks);
+
+    // Rehashing is O(size), so only done for small books. The table will rehash
+    // again on the matching path if the book later outgrows 2x its current size.
+    size_t live = orders_by_id.size();
+    size_t buckets = orders_by_id.bucket_count();
+    if (budget.max_index_rehash > 0 && live <= budget.max_index_rehash
+        && buckets > 4 * std::max<size_t>(live, 16)) {
+        orders_by_id.reserve(2 * std::max<size_t>(live, 16));
+        if (orders_by_id.bucket_count() < buckets) {
+            released += (buckets - orders_by_id.bucket_count()) * sizeof(void*);
+        }
+    }
+
+    return released;
 }
\ No newline at end of file
@@ -17,6 +17,40 @@ public:
     int32_t total_quantity = 0;
 };
 
+// Running execution statistics, updated by the matching engine on every fill
+struct FillStats {
+    uint64_t fill_count = 0;        // number of resting orders hit (partial or full)
+    int64_t filled_quantity = 0;    // total quantity traded
+    int64_t filled_notional = 0;    // sum of price * quantity at the resting price
+};
+
+// Per-component breakdown returned by LimitOrderBook::memory_usage()
+struct BookMemoryReport {
+    MemoryUsage order_pool;     // Order slots + free list (shared if the pool is borrowed)
+    MemoryUsage price_levels;   // level ladder + per-level order vectors
+    MemoryUsage order_index;    // orders_by_id buckets and nodes (node size estimated)
+    MemoryUsage active_levels;  // active bid/ask sets (node size estimated)
+
+    MemoryUsage total() const {
+        MemoryUsage t;
+        for (const auto* u : {&order_pool, &price_levels, &order_index, &active_levels}) {
+            t.live_bytes += u->live_bytes;
+            t.reserved_bytes += u->reserved_bytes;
+        }
+        return t;
+    }
+};
+
+// Caps the work done by one LimitOrderBook::compact() call so it can run between
+// events (or from an idle loop) without stalling the matching path
+struct CompactionBudget {
+    size_t max_levels = 256;            // price levels inspected per call
+    size_t max_pool_chunks = 2;         // idle MemoryPool chunks returned per call
+    // Opt-in: shrink orders_by_id while it holds at most this many orders. Off by default
+    // because it gives up the up-front reserve, and a later burst rehashes on the matching path.
+    size_t max_index_rehash = 0;
+};
+
 class LimitOrderBook {
 private:
     static constexpr double MIN_PRICE = 90.0;
@@ -28,7 +62,18 @@ private:
     std::vector<PriceLevel> price_levels;
     // std::unordered_map<int64_t, Order*> orders_by_id;
     // absl::flat_hash_map<int64_t, Order*> orders_by_id; // For quick order lookup by ID
-    MemoryPool<Order> order_pool;
+    MemoryPool<Order> owned_pool;   // empty when the book borrows an external pool
+    MemoryPool<Order>* order_pool;  // pool actually used for Order allocation
+    FillStats fill_stats;
+
+    // Rolling hashes for deterministic replay checks, both updated in O(1) per change:
+    // book_hash sums a term per resting order (id, price, qty, side) plus a term per
+    // queue link (order, order ahead of it) so time priority within a level counts,
+    // fill_hash is chained over the fill stream so sequence and counterparties matter
+    uint64_t book_hash = 0;
+    uint64_t fill_hash = 0;
+
+    size_t compact_cursor = 0;  // next price level compact() will inspect
 
     std::set<size_t> active_bids; // indices of price levels with buy orders
     std::set<size_t> active_asks; // indices of price levels with sell orders
@@ -38,20 +83,95 @@ private:
     }
     void match(Order* incoming);
     void insert_order(Order* incoming);
+    // splitmix64 finaliser - cheap, well-distributed 64-bit mixing
+    static uint64_t mix64(uint64_t x) {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+    static uint64_t order_hash(int64_t order_id, int64_t price, int32_t quantity, OrderSide side) {
+        uint64_t fields = (static_cast<uint64_t>(price) << 33)
+                        ^ (static_cast<uint64_t>(static_cast<uint32_t>(quantity)) << 1)
+                        ^ static_cast<uint64_t>(side == OrderSide::Sell);
+        return mix64(static_cast<uint64_t>(order_id) ^ mix64(fields));
+    }
+    void hash_add(const Order* o) { book_hash += order_hash(o->order_id, o->price, o->quantity, o->side); }
+    void hash_remove(const Order* o) { book_hash -= order_hash(o->order_id, o->price, o->quantity, o->side); }
+    // Independent of quantity, so modifies and partial fills leave links alone
+    static uint64_t link_hash(const Order* ahead, const Order* o) {
+        uint64_t ahead_key = ahead ? mix64(static_cast<uint64_t>(ahead->order_id))
+                                   : 0x9e3779b97f4a7c15ULL; // head of level
+        return mix64(ahead_key ^ (static_cast<uint64_t>(o->order_id) * 0xff51afd7ed558ccdULL));
+    }
+    // Erases a queued order and re-links its successor to the order ahead of it
+    std::vector<Order*>::iterator unlink_order(std::vector<Order*>& orders_vec,
+                                               std::vector<Order*>::iterator it) {
+        const Order* ahead = it == orders_vec.begin() ? nullptr : *(it - 1);
+        book_hash -= link_hash(ahead, *it);
+        if (it + 1 != orders_vec.end()) {
+            book_hash -= link_hash(*it, *(it + 1));
+            book_hash += link_hash(ahead, *(it + 1));
+        }
+        return orders_vec.erase(it);
+    }
+
+    // Called before the resting order's quantity is reduced
+    void record_fill(const Order* incoming, const Order* resting, int32_t quantity) {
+        ++fill_stats.fill_count;
+        fill_stats.filled_quantity += quantity;
+        fill_stats.filled_notional += resting->price * quantity;
+
+        hash_remove(resting);
+        fill_hash = mix64(fill_hash + static_cast<uint64_t>(incoming->order_id)
+                          + order_hash(resting->order_id, resting->price, quantity, resting->side));
+    }
 public:
     std::unordered_map<int64_t, Order*> orders_by_id;
     // absl::flat_hash_map<int64_t, Order*> orders_by_id; // For quick order lookup by ID
     explicit LimitOrderBook(size_t pool_size = 1'000'000)
-        : price_levels(NUM_LEVELS), order_pool(pool_size) {
+        : price_levels(NUM_LEVELS), owned_pool(pool_size), order_pool(&owned_pool) {
+            orders_by_id.reserve(100'000);
+        }
+    // Borrow an externally owned pool (e.g. one per backtest worker thread) so
+    // short-lived books don't each pre-allocate their own storage.
+    // Resting orders are handed back to the pool when the book is destroyed.
+    explicit LimitOrderBook(MemoryPool<Order>& shared_pool)
+        : price_levels(NUM_LEVELS), owned_pool(0), order_pool(&shared_pool) {
             orders_by_id.reserve(100'000);
         }
+    ~LimitOrderBook();
+
+    // order_pool may point at owned_pool, so copying/moving would dangle
+    LimitOrderBook(const LimitOrderBook&) = delete;
+    LimitOrderBook& operator=(const LimitOrderBook&) = delete;
+
+    // Prices outside the fixed ladder have no level to rest on
+    static bool is_valid_price(double price) { return price >= MIN_PRICE && price <= MAX_PRICE; }
+
     // void add_order(int64_t order_id, int64_t price, int32_t quantity, OrderSide side);
+    // Orders priced outside the ladder are rejected (ignored), like unknown ids on cancel
     void process_order(int64_t order_id, int64_t price, int32_t quantity, OrderSide side);
     void cancel_order(int64_t order_id);
     void modify_order(int64_t order_id, int32_t new_quantity);
 
     // Getter for vector of price levels
     const std::vector<PriceLevel>& get_price_levels() const { return price_levels; }
+    const FillStats& get_fill_stats() const { return fill_stats; }
+    // Counted from the levels: orders_by_id misses orders shadowed by a reused id
+    size_t resting_order_count() const;
+
+    // Two engines fed the same events must report identical hashes after every event
+    uint64_t get_book_hash() const { return book_hash; }
+    uint64_t get_fill_hash() const { return fill_hash; }
+    uint64_t get_state_hash() const { return mix64(book_hash ^ mix64(fill_hash)); }
+
+    // Live vs reserved bytes for each internal container
+    BookMemoryReport memory_usage() const;
+
+    // One incremental compaction step: frees storage of empty levels, trims oversized
+    // level vectors, returns idle pool chunks and (if the budget allows) shrinks orders_by_id.
+    // Matching results are unaffected. Returns the number of bytes released.
+    size_t compact(const CompactionBudget& budget = {});
 };
 
 #endif // ORDERBOOK_LIMITORDERBOOK_H
\ No newline at end of file
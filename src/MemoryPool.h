@@ -2,36 +2,206 @@
 #define ORDERBOOK_MEMORYPOOL_H
 
 #include <vector>
-#include <stack>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <memory>
+#include <new>
+#include <type_traits>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Bytes a component needs for its live contents vs bytes it currently holds
+struct MemoryUsage {
+    size_t live_bytes = 0;
+    size_t reserved_bytes = 0;
+};
 
 template <typename T>
 
 class MemoryPool {
+    // Free slots store the next free offset in their own bytes, and released pages may
+    // read back as zeroes - both need a trivially copyable T
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) >= sizeof(uint16_t),
+                  "MemoryPool requires a trivially copyable T of at least 2 bytes");
+
     private:
-        std::vector<T> pool;            // actual storage - contiguous
-        std::stack<size_t> free_list;   // stack of free indexes in pool
+        // Slots are grouped into chunks so fully idle regions can be handed back to the OS.
+        // Storage is aligned to the largest common page size, so for T = Order (24 bytes)
+        // every chunk covers whole pages.
+        static constexpr size_t CHUNK_SIZE = 4096;
+        static constexpr size_t STORAGE_ALIGN = 16384;
+        static constexpr uint16_t NO_SLOT = UINT16_MAX;
+
+        struct Chunk {
+            uint16_t free_head = NO_SLOT;       // intrusive free list through freed slots
+            uint16_t fresh = 0;                 // slots [fresh, CHUNK_SIZE) never handed out
+            uint32_t live = 0;                  // allocated slots
+            size_t released_bytes = 0;          // page bytes returned to the OS
+            bool released = false;
+            bool listed = true;                 // on available_chunks or released_chunks
+        };
+
+        T* pool = nullptr;                      // actual storage - contiguous
+        size_t pool_capacity = 0;
+        size_t live_count = 0;
+        std::vector<Chunk> chunks;
+        std::vector<uint32_t> available_chunks; // stack of resident chunks that may have a free slot
+        std::vector<uint32_t> released_chunks;  // fallback once every resident chunk is full
+        size_t released_bytes = 0;
+        size_t release_cursor = 0;
+
+        size_t chunk_slots(size_t chunk) const {
+            return std::min(CHUNK_SIZE, pool_capacity - chunk * CHUNK_SIZE);
+        }
+
+        T* take_slot(size_t idx) {
+            Chunk& chunk = chunks[idx];
+            T* base = pool + idx * CHUNK_SIZE;
+            size_t slot;
+            if (chunk.free_head != NO_SLOT) {
+                slot = chunk.free_head;
+                std::memcpy(&chunk.free_head, base + slot, sizeof(uint16_t));
+            } else if (chunk.fresh < chunk_slots(idx)) {
+                slot = chunk.fresh++;
+            } else {
+                return nullptr;
+            }
+            chunk.live++;
+            live_count++;
+            return base + slot;
+        }
+
+        // Drops the physical pages fully inside [begin, end). The address range stays
+        // valid; touching it again faults in fresh pages. Returns bytes released.
+        static size_t release_pages(void* begin, void* end) {
+#if defined(__unix__) || defined(__APPLE__)
+            static const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+            uintptr_t lo = (reinterpret_cast<uintptr_t>(begin) + page - 1) & ~(page - 1);
+            uintptr_t hi = reinterpret_cast<uintptr_t>(end) & ~(page - 1);
+            if (lo >= hi) return 0;
+#if defined(__APPLE__)
+            int advice = MADV_FREE;
+#else
+            int advice = MADV_DONTNEED;
+#endif
+            if (madvise(reinterpret_cast<void*>(lo), hi - lo, advice) != 0) return 0;
+            return hi - lo;
+#else
+            (void)begin; (void)end;
+            return 0;
+#endif
+        }
 
     public:
-        explicit MemoryPool(size_t capacity) {
-            pool.resize(capacity);
-            for (size_t i = 0; i < capacity; i++) {
-                free_list.push(i);
+        explicit MemoryPool(size_t capacity) : pool_capacity(capacity) {
+            if (capacity > 0) {
+                pool = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{STORAGE_ALIGN}));
+                std::uninitialized_value_construct_n(pool, capacity); // pre-fault every page
+            }
+            size_t num_chunks = (capacity + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            chunks.resize(num_chunks);
+            // Each chunk is on at most one stack, so neither ever grows on the hot path
+            available_chunks.reserve(num_chunks);
+            released_chunks.reserve(num_chunks);
+            for (size_t c = num_chunks; c > 0; c--) {
+                available_chunks.push_back(static_cast<uint32_t>(c - 1));
             }
         }
 
+        ~MemoryPool() {
+            if (!pool) return;
+            std::destroy_n(pool, pool_capacity);
+            ::operator delete(pool, std::align_val_t{STORAGE_ALIGN});
+        }
+
+        MemoryPool(const MemoryPool&) = delete;
+        MemoryPool& operator=(const MemoryPool&) = delete;
+
         T* allocate() {
-            if (free_list.empty()) {
-                throw std::runtime_error("MemoryPool exhausted!");
+            while (!available_chunks.empty()) {
+                size_t idx = available_chunks.back();
+                if (chunks[idx].released) {
+                    // Went idle and was released while listed - keep it as a fallback
+                    available_chunks.pop_back();
+                    released_chunks.push_back(static_cast<uint32_t>(idx));
+                    continue;
+                }
+                if (T* slot = take_slot(idx)) return slot;
+                chunks[idx].listed = false;
+                available_chunks.pop_back();
+            }
+
+            // Every resident chunk is full: bring a released one back. Its pages fault
+            // in on first touch, the same cost as growing into untouched memory.
+            if (!released_chunks.empty()) {
+                size_t idx = released_chunks.back();
+                released_chunks.pop_back();
+                available_chunks.push_back(static_cast<uint32_t>(idx));
+                Chunk& chunk = chunks[idx];
+                released_bytes -= chunk.released_bytes;
+                chunk.released_bytes = 0;
+                chunk.released = false;
+                return take_slot(idx);
             }
-            size_t idx = free_list.top();
-            free_list.pop();
-            return &pool[idx];
+            throw std::runtime_error("MemoryPool exhausted!");
         }
 
         void deallocate(T* ptr) {
-            size_t idx = ptr - &pool[0];
-            free_list.push(idx);
+            size_t idx = ptr - pool;
+            Chunk& chunk = chunks[idx / CHUNK_SIZE];
+            std::memcpy(ptr, &chunk.free_head, sizeof(uint16_t));
+            chunk.free_head = static_cast<uint16_t>(idx % CHUNK_SIZE);
+            chunk.live--;
+            live_count--;
+            if (!chunk.listed) {
+                chunk.listed = true;
+                available_chunks.push_back(static_cast<uint32_t>(idx / CHUNK_SIZE));
+            }
+        }
+
+        // Returns the pages of up to max_chunks chunks with no live objects to the OS.
+        // The free list lives inside the slots, so it goes with them. Resumes where the
+        // previous call stopped and inspects each chunk at most once per call, so it is
+        // safe to call between events.
+        size_t release_idle_chunks(size_t max_chunks) {
+            size_t freed = 0;
+            size_t released = 0;
+            for (size_t n = 0; n < chunks.size() && released < max_chunks; n++) {
+                size_t idx = release_cursor;
+                release_cursor = (release_cursor + 1) % chunks.size();
+                Chunk& chunk = chunks[idx];
+                if (chunk.live != 0 || chunk.released) continue;
+
+                size_t begin = idx * CHUNK_SIZE;
+                size_t page_bytes = release_pages(pool + begin, pool + begin + chunk_slots(idx));
+
+                // Every slot is free again, so the chunk restarts from a clean bump index
+                chunk.free_head = NO_SLOT;
+                chunk.fresh = 0;
+                chunk.released = true;
+                chunk.released_bytes = page_bytes;
+                released_bytes += page_bytes;
+                freed += page_bytes;
+                released++;
+            }
+            return freed;
+        }
+
+        size_t capacity() const { return pool_capacity; }
+        size_t in_use() const { return live_count; }
+
+        MemoryUsage memory_usage() const {
+            MemoryUsage usage;
+            usage.live_bytes = live_count * sizeof(T);
+            usage.reserved_bytes = pool_capacity * sizeof(T) - released_bytes
+                                 + chunks.capacity() * sizeof(Chunk)
+                                 + available_chunks.capacity() * sizeof(uint32_t)
+                                 + released_chunks.capacity() * sizeof(uint32_t);
+            return usage;
         }
 };
-#endif // ORDERBOOK_MEMORYPOOL_H
\ No newline at end of file
+#endif // ORDERBOOK_MEMORYPOOL_H
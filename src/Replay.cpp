@@ -0,0 +1,82 @@
+#include "Replay.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// File layout: 8-byte magic, uint64 count, then count raw uint64 hashes (host byte order)
+static constexpr char TRACE_MAGIC[8] = {'L', 'O', 'B', 'H', 'A', 'S', 'H', '1'};
+
+// Replays can run to millions of live orders, so size the pool off the event count
+static size_t replay_pool_size(const std::vector<OrderEvent>& events) {
+    return std::max<size_t>(events.size(), 1);
+}
+
+std::vector<uint64_t> record_hash_trace(const std::vector<OrderEvent>& events) {
+    LimitOrderBook lob(replay_pool_size(events));
+    std::vector<uint64_t> trace;
+    trace.reserve(events.size());
+    for (const auto& ev : events) {
+        apply_event(lob, ev);
+        trace.push_back(lob.get_state_hash());
+    }
+    return trace;
+}
+
+void save_hash_trace(const std::string& path, const std::vector<uint64_t>& trace) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Could not open hash trace for writing: " + path);
+    }
+    uint64_t count = trace.size();
+    out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(trace.data()),
+              static_cast<std::streamsize>(count * sizeof(uint64_t)));
+}
+
+std::vector<uint64_t> load_hash_trace(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Could not open hash trace: " + path);
+    }
+    char magic[sizeof(TRACE_MAGIC)];
+    uint64_t count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        throw std::runtime_error("Not a hash trace file: " + path);
+    }
+
+    // Validate the header count against the payload before allocating for it
+    auto payload_start = in.tellg();
+    in.seekg(0, std::ios::end);
+    uint64_t payload_bytes = static_cast<uint64_t>(in.tellg() - payload_start);
+    in.seekg(payload_start);
+    if (count > payload_bytes / sizeof(uint64_t)) {
+        throw std::runtime_error("Truncated hash trace: " + path);
+    }
+
+    std::vector<uint64_t> trace(count);
+    in.read(reinterpret_cast<char*>(trace.data()),
+            static_cast<std::streamsize>(count * sizeof(uint64_t)));
+    if (!in) {
+        throw std::runtime_error("Truncated hash trace: " + path);
+    }
+    return trace;
+}
+
+std::optional<Divergence> verify_hash_trace(const std::vector<OrderEvent>& events,
+                                            const std::vector<uint64_t>& trace) {
+    LimitOrderBook lob(replay_pool_size(events));
+    for (size_t i = 0; i < events.size(); i++) {
+        apply_event(lob, events[i]);
+        uint64_t actual = lob.get_state_hash();
+        if (i >= trace.size()) return Divergence{i, 0, actual};
+        if (trace[i] != actual) return Divergence{i, trace[i], actual};
+    }
+    if (trace.size() > events.size()) {
+        return Divergence{events.size(), trace[events.size()], 0};
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,26 @@
+#ifndef ORDERBOOK_REPLAY_H
+#define ORDERBOOK_REPLAY_H
+
+#include "Backtest.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+// A hash trace holds LimitOrderBook::get_state_hash() after every event of a replay.
+// Record one with a known-good engine build, then verify a candidate build against it.
+std::vector<uint64_t> record_hash_trace(const std::vector<OrderEvent>& events);
+void save_hash_trace(const std::string& path, const std::vector<uint64_t>& trace);
+std::vector<uint64_t> load_hash_trace(const std::string& path);
+
+struct Divergence {
+    size_t event_idx;   // first event whose resulting state differs
+    uint64_t expected;  // 0 if the trace ran out before the events did
+    uint64_t actual;
+};
+
+// Replays events and stops at the first state hash that differs from the trace.
+// Returns nullopt if every event matches and the trace has no extra entries.
+std::optional<Divergence> verify_hash_trace(const std::vector<OrderEvent>& events,
+                                            const std::vector<uint64_t>& trace);
+
+#endif // ORDERBOOK_REPLAY_H
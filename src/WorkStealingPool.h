@@ -0,0 +1,90 @@
+#ifndef ORDERBOOK_WORKSTEALINGPOOL_H
+#define ORDERBOOK_WORKSTEALINGPOOL_H
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool that runs a batch of independent tasks across worker threads.
+// Tasks are split evenly up front; a worker that drains its own queue steals
+// from the front of the others, so uneven task costs still balance out.
+class WorkStealingPool {
+    private:
+        // Each queue on its own cache line so owners and thieves don't false-share
+        struct alignas(64) WorkQueue {
+            std::mutex mutex;
+            std::deque<size_t> tasks;
+        };
+
+        size_t num_threads;
+
+        static std::optional<size_t> pop_back(WorkQueue& q) {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) return std::nullopt;
+            size_t idx = q.tasks.back();
+            q.tasks.pop_back();
+            return idx;
+        }
+
+        static std::optional<size_t> steal_front(WorkQueue& q) {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) return std::nullopt;
+            size_t idx = q.tasks.front();
+            q.tasks.pop_front();
+            return idx;
+        }
+
+    public:
+        explicit WorkStealingPool(size_t num_threads)
+            : num_threads(std::max<size_t>(1, num_threads)) {}
+
+        size_t size() const { return num_threads; }
+
+        // Calls task(worker_id, task_idx) once for every task_idx in [0, num_tasks)
+        // and blocks until all have finished. The first exception thrown by a task
+        // is rethrown here after every worker has stopped.
+        template <typename Task>
+        void run(size_t num_tasks, Task&& task) {
+            std::vector<WorkQueue> queues(num_threads);
+            for (size_t i = 0; i < num_tasks; i++) {
+                queues[i * num_threads / num_tasks].tasks.push_back(i);
+            }
+
+            std::exception_ptr first_error;
+            std::mutex error_mutex;
+
+            auto worker = [&](size_t worker_id) {
+                try {
+                    while (true) {
+                        std::optional<size_t> idx = pop_back(queues[worker_id]);
+                        // All tasks are queued before workers start, so once every
+                        // queue is empty there is nothing left to do
+                        for (size_t k = 1; !idx && k < num_threads; k++) {
+                            idx = steal_front(queues[(worker_id + k) % num_threads]);
+                        }
+                        if (!idx) break;
+                        task(worker_id, *idx);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!first_error) first_error = std::current_exception();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads - 1);
+            for (size_t w = 1; w < num_threads; w++) {
+                threads.emplace_back(worker, w);
+            }
+            worker(0); // calling thread acts as worker 0
+            for (auto& t : threads) t.join();
+
+            if (first_error) std::rethrow_exception(first_error);
+        }
+};
+
+#endif // ORDERBOOK_WORKSTEALINGPOOL_H
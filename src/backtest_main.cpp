@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "Backtest.h"
+
+// Strategy orders get ids well clear of the replayed flow
+static constexpr int64_t STRATEGY_ID_BASE = 1'000'000'000'000;
+
+// Demo parameter sweep: variant k fires an immediate-or-cancel taker order every
+// (50 + k) events, alternating sides, sized 10 + k % 50
+static std::vector<BacktestVariant> make_variants(size_t count) {
+    std::vector<BacktestVariant> variants;
+    variants.push_back({"replay-only", nullptr});
+
+    for (size_t k = 1; k < count; k++) {
+        size_t interval = 50 + k;
+        int32_t qty = static_cast<int32_t>(10 + k % 50);
+        variants.push_back({
+            "ioc-every-" + std::to_string(interval) + "-qty-" + std::to_string(qty),
+            [interval, qty](LimitOrderBook& lob, const OrderEvent&, size_t event_idx) {
+                if (event_idx % interval != 0) return;
+                int64_t id = STRATEGY_ID_BASE + static_cast<int64_t>(event_idx);
+                bool buy = (event_idx / interval) % 2 == 0;
+                lob.process_order(id, buy ? 110 : 90, qty, buy ? OrderSide::Buy : OrderSide::Sell);
+                lob.cancel_order(id); // drop any unfilled remainder
+            }
+        });
+    }
+    return variants;
+}
+
+// Usage: BacktestApp [order_flow.csv] [num_variants]
+// Without a file, a synthetic 100K-event flow is generated.
+int main(int argc, char** argv) {
+    std::vector<OrderEvent> events;
+    try {
+        events = argc > 1 ? load_order_flow(argv[1]) : generate_order_flow(100'000);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    size_t num_variants = argc > 2 ? std::stoul(argv[2]) : 64;
+    auto variants = make_variants(num_variants);
+
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    std::cout << "Replaying " << events.size() << " events x " << variants.size() << " variants\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    BacktestReport last;
+    double base_rate = 0.0;
+    for (size_t threads : thread_counts) {
+        BacktestRunner runner(threads);
+        last = runner.run(events, variants);
+        if (base_rate == 0.0) base_rate = last.runs_per_sec;
+
+        std::cout << "Threads: " << std::setw(3) << threads
+                  << " | " << std::setw(10) << last.elapsed_ms << " ms"
+                  << " | " << std::setw(8) << last.runs_per_sec << " runs/sec"
+                  << " | speedup " << last.runs_per_sec / base_rate << "x\n";
+    }
+
+    std::cout << "\n--- Per-run fill statistics (" << last.num_threads << " threads) ---\n";
+    for (const auto& r : last.runs) {
+        std::cout << std::left << std::setw(28) << r.name << std::right
+                  << " | fills: " << std::setw(8) << r.fills.fill_count
+                  << " | qty: " << std::setw(10) << r.fills.filled_quantity
+                  << " | notional: " << std::setw(12) << r.fills.filled_notional
+                  << " | resting: " << std::setw(6) << r.resting_orders
+                  << " | " << r.elapsed_ms << " ms (worker " << r.worker << ")\n";
+    }
+
+    return 0;
+}
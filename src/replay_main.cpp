@@ -0,0 +1,85 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "Replay.h"
+
+// Compares matching output of two engine builds:
+//   ReplayApp generate <num_events> <flow.csv> [seed]   write a synthetic order flow
+//   ReplayApp record <flow.csv> <trace.bin>             run with the reference build
+//   ReplayApp verify <flow.csv> <trace.bin>             run with the candidate build
+// verify exits with 2 and prints the first divergent message if the state hashes differ.
+static int usage() {
+    std::cerr << "Usage:\n"
+              << "  ReplayApp generate <num_events> <flow.csv> [seed]\n"
+              << "  ReplayApp record <flow.csv> <trace.bin>\n"
+              << "  ReplayApp verify <flow.csv> <trace.bin>\n";
+    return 1;
+}
+
+static void print_rate(const char* what, size_t num_events,
+                       std::chrono::high_resolution_clock::time_point start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    double ops_per_sec = (num_events / elapsed_ms) * 1000.0;
+    std::cout << what << " " << num_events << " events in " << elapsed_ms << " ms ("
+              << ops_per_sec << " ops/sec)\n";
+}
+
+static int run(int argc, char** argv) {
+    if (argc < 4) return usage();
+    std::string mode = argv[1];
+
+    if (mode == "generate") {
+        uint32_t seed = argc > 4 ? static_cast<uint32_t>(std::stoul(argv[4])) : 42;
+        auto events = generate_order_flow(std::stoull(argv[2]), seed);
+        save_order_flow(argv[3], events);
+        std::cout << "Wrote " << events.size() << " events to " << argv[3] << "\n";
+        return 0;
+    }
+
+    auto events = load_order_flow(argv[2]);
+
+    if (mode == "record") {
+        auto start = std::chrono::high_resolution_clock::now();
+        auto trace = record_hash_trace(events);
+        print_rate("Recorded", events.size(), start);
+        save_hash_trace(argv[3], trace);
+        std::cout << "Final state hash: " << std::hex << std::setw(16) << std::setfill('0')
+                  << (trace.empty() ? 0 : trace.back()) << "\n";
+        return 0;
+    }
+
+    if (mode == "verify") {
+        auto trace = load_hash_trace(argv[3]);
+        auto start = std::chrono::high_resolution_clock::now();
+        auto divergence = verify_hash_trace(events, trace);
+        print_rate("Verified", divergence ? divergence->event_idx + 1 : events.size(), start);
+
+        if (!divergence) {
+            std::cout << "OK: all " << events.size() << " events match the trace\n";
+            return 0;
+        }
+        std::cout << "DIVERGED at event " << divergence->event_idx;
+        if (divergence->event_idx < events.size()) {
+            std::cout << " (message: " << format_event(events[divergence->event_idx]) << ")";
+        } else {
+            std::cout << " (trace is longer than the order flow)";
+        }
+        std::cout << std::hex << std::setfill('0')
+                  << "\n  expected: " << std::setw(16) << divergence->expected
+                  << "\n  actual:   " << std::setw(16) << divergence->actual << "\n";
+        return 2;
+    }
+
+    return usage();
+}
+
+int main(int argc, char** argv) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,10 +1,14 @@
 #include "LimitOrderBook.h"
+#include "Backtest.h"
+#include "Replay.h"
 #include <gtest/gtest.h>
 #include <chrono>
 #include <random>
 #include <unordered_set>
 #include <iostream>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 
 // Ladder parameters mirrored for tests (match your LOB constants)
 static constexpr double MIN_PRICE = 90.0;
@@ -163,6 +167,18 @@ TEST(LimitOrderBookTest, ModifyAfterPartialFill) {
     EXPECT_EQ(level_total_by_side(levels[idx], OrderSide::Buy), 80);
 }
 
+TEST(LimitOrderBookTest, OutOfLadderPriceIsRejected) {
+    LimitOrderBook lob;
+    lob.process_order(1, 900, 10, OrderSide::Buy);
+    lob.process_order(2, 89, 10, OrderSide::Sell);
+    lob.process_order(3, 111, 10, OrderSide::Sell);
+    EXPECT_TRUE(lob.orders_by_id.empty());
+    EXPECT_EQ(lob.get_book_hash(), 0u);
+
+    lob.process_order(4, 110, 10, OrderSide::Sell); // top of ladder is still valid
+    EXPECT_EQ(lob.get_price_levels().back().total_quantity, 10);
+}
+
 TEST(LimitOrderBookTest, SameSideDoesNotMatch) {
     LimitOrderBook lob;
     lob.process_order(1, 100.00, 40, OrderSide::Buy);
@@ -232,6 +248,445 @@ TEST(LimitOrderBookTest, PartialFillLeavesLevelActive) {
     EXPECT_EQ(levels[idx].total_quantity, 30); // 50 - 20 = 30 left
 }
 
+// --- Fill Statistics & Shared Pools ---
+
+TEST(LimitOrderBookTest, FillStatsTrackExecutions) {
+    LimitOrderBook lob;
+    lob.process_order(1, 101.00, 50, OrderSide::Sell);
+    lob.process_order(2, 102.00, 75, OrderSide::Sell);
+    lob.process_order(3, 102.00, 100, OrderSide::Buy); // fills 50 @ 101, 50 @ 102
+
+    const auto& stats = lob.get_fill_stats();
+    EXPECT_EQ(stats.fill_count, 2u);
+    EXPECT_EQ(stats.filled_quantity, 100);
+    EXPECT_EQ(stats.filled_notional, 50 * 101 + 50 * 102);
+}
+
+TEST(LimitOrderBookTest, SharedPoolReclaimsRestingOrders) {
+    MemoryPool<Order> pool(2);
+    {
+        LimitOrderBook lob(pool);
+        lob.process_order(1, 100.00, 10, OrderSide::Buy);
+        lob.process_order(2, 101.00, 10, OrderSide::Sell);
+    } // both orders still resting -> returned to pool here
+
+    LimitOrderBook lob(pool);
+    EXPECT_NO_THROW(lob.process_order(3, 100.00, 10, OrderSide::Buy));
+    EXPECT_NO_THROW(lob.process_order(4, 101.00, 10, OrderSide::Sell));
+}
+
+TEST(LimitOrderBookTest, SharedPoolReclaimsOrdersWithReusedIds) {
+    MemoryPool<Order> pool(20);
+    for (int book = 0; book < 5; ++book) {
+        LimitOrderBook lob(pool);
+        // 20 non-crossing bids cycling ids 0..9 - half are shadowed in orders_by_id
+        for (int i = 0; i < 20; ++i) {
+            ASSERT_NO_THROW(lob.process_order(i % 10, 91 + i % 10, 10, OrderSide::Buy))
+                << " book " << book << ", order " << i;
+        }
+    }
+}
+
+TEST(LimitOrderBookTest, RestingCountIncludesShadowedIds) {
+    LimitOrderBook lob;
+    lob.process_order(5, 100, 10, OrderSide::Buy);
+    lob.process_order(5, 101, 10, OrderSide::Buy);  // shadows the first in orders_by_id
+    lob.process_order(6, 101, 10, OrderSide::Sell); // fills the second, erasing id 5's entry
+    EXPECT_TRUE(lob.orders_by_id.empty());
+    EXPECT_EQ(lob.resting_order_count(), 1u);
+}
+
+TEST(LimitOrderBookTest, CancelWithReusedIdFreesEachSlotOnce) {
+    MemoryPool<Order> pool(16);
+    {
+        LimitOrderBook lob(pool);
+        lob.process_order(7, 100, 10, OrderSide::Buy);
+        lob.process_order(7, 100, 20, OrderSide::Buy);
+        lob.cancel_order(7); // cancels the order orders_by_id points at (the newer one)
+
+        const auto& level = lob.get_price_levels()[price_to_index(100.00)];
+        ASSERT_EQ(level.orders.size(), 1u);
+        EXPECT_EQ(level.orders[0]->quantity, 10);
+        EXPECT_EQ(level.total_quantity, 10);
+    }
+
+    std::unordered_set<Order*> handed_out;
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_TRUE(handed_out.insert(pool.allocate()).second) << " slot handed out twice";
+    }
+}
+
+// --- State Hashing & Replay Verification ---
+
+TEST(LimitOrderBookTest, BookHashDependsOnlyOnRestingOrders) {
+    LimitOrderBook a, b;
+    a.process_order(1, 100.00, 40, OrderSide::Buy);
+    a.process_order(2, 101.00, 30, OrderSide::Sell);
+    a.modify_order(1, 60);
+
+    // Same resting orders reached via a different path
+    b.process_order(2, 101.00, 30, OrderSide::Sell);
+    b.process_order(3, 99.00, 10, OrderSide::Buy);
+    b.process_order(1, 100.00, 60, OrderSide::Buy);
+    b.cancel_order(3);
+
+    EXPECT_EQ(a.get_book_hash(), b.get_book_hash());
+
+    a.cancel_order(1);
+    a.cancel_order(2);
+    EXPECT_EQ(a.get_book_hash(), 0u);
+}
+
+TEST(LimitOrderBookTest, BookHashTracksQueuePosition) {
+    LimitOrderBook a, b;
+    a.process_order(1, 100.00, 10, OrderSide::Buy);
+    a.process_order(2, 100.00, 20, OrderSide::Buy);
+    b.process_order(2, 100.00, 20, OrderSide::Buy);
+    b.process_order(1, 100.00, 10, OrderSide::Buy);
+    EXPECT_NE(a.get_book_hash(), b.get_book_hash());
+
+    // Removing the head re-links the rest of the queue
+    a.process_order(3, 100.00, 5, OrderSide::Buy);
+    b.process_order(3, 100.00, 5, OrderSide::Buy);
+    a.cancel_order(1);
+    b.cancel_order(1);
+    EXPECT_EQ(a.get_book_hash(), b.get_book_hash());
+}
+
+TEST(LimitOrderBookTest, FillHashTracksFillSequence) {
+    LimitOrderBook a, b;
+    a.process_order(1, 100.00, 50, OrderSide::Sell);
+    b.process_order(1, 100.00, 50, OrderSide::Sell);
+    EXPECT_EQ(a.get_state_hash(), b.get_state_hash());
+
+    // Same remaining book, different incoming counterparties
+    a.process_order(2, 100.00, 20, OrderSide::Buy);
+    b.process_order(3, 100.00, 20, OrderSide::Buy);
+    EXPECT_EQ(a.get_book_hash(), b.get_book_hash());
+    EXPECT_NE(a.get_fill_hash(), b.get_fill_hash());
+    EXPECT_NE(a.get_state_hash(), b.get_state_hash());
+}
+
+TEST(ReplayTest, TraceVerifiesAgainstItself) {
+    auto events = generate_order_flow(50'000);
+    auto trace = record_hash_trace(events);
+    ASSERT_EQ(trace.size(), events.size());
+    EXPECT_FALSE(verify_hash_trace(events, trace).has_value());
+}
+
+TEST(ReplayTest, ReportsFirstDivergentEvent) {
+    auto events = generate_order_flow(10'000);
+    auto trace = record_hash_trace(events);
+
+    // Perturb one add: every state from that event on differs
+    size_t target = 0;
+    for (size_t i = 5'000; i < events.size(); ++i) {
+        if (events[i].type == EventType::Add) { target = i; break; }
+    }
+    ASSERT_GT(target, 0u);
+    auto altered = events;
+    altered[target].quantity += 1;
+
+    auto divergence = verify_hash_trace(altered, trace);
+    ASSERT_TRUE(divergence.has_value());
+    EXPECT_EQ(divergence->event_idx, target);
+    EXPECT_EQ(divergence->expected, trace[target]);
+
+    // A trace cut short diverges where it runs out
+    trace.resize(100);
+    divergence = verify_hash_trace(events, trace);
+    ASSERT_TRUE(divergence.has_value());
+    EXPECT_EQ(divergence->event_idx, 100u);
+}
+
+TEST(ReplayTest, ReportsInsertThatBreaksTimePriority) {
+    std::vector<OrderEvent> events = {
+        {EventType::Add, 1, 100, 10, OrderSide::Buy},
+        {EventType::Add, 2, 100, 10, OrderSide::Buy},
+        {EventType::Add, 3, 100, 10, OrderSide::Sell},
+    };
+
+    // Trace of an engine that queues order 2 ahead of order 1: same resting
+    // orders after event 1, but the later fill hits order 2 first
+    std::vector<uint64_t> faulty_trace;
+    {
+        LimitOrderBook lob;
+        lob.process_order(1, 100, 10, OrderSide::Buy);
+        faulty_trace.push_back(lob.get_state_hash());
+    }
+    {
+        LimitOrderBook lob;
+        lob.process_order(2, 100, 10, OrderSide::Buy);
+        lob.process_order(1, 100, 10, OrderSide::Buy);
+        faulty_trace.push_back(lob.get_state_hash());
+        lob.process_order(3, 100, 10, OrderSide::Sell);
+        faulty_trace.push_back(lob.get_state_hash());
+    }
+
+    auto divergence = verify_hash_trace(events, faulty_trace);
+    ASSERT_TRUE(divergence.has_value());
+    EXPECT_EQ(divergence->event_idx, 1u);
+}
+
+TEST(ReplayTest, RejectsTraceWithOversizedCount) {
+    auto trace = record_hash_trace(generate_order_flow(100, 3));
+    const std::string path = "replay_corrupt_trace.bin";
+    save_hash_trace(path, trace);
+    {
+        // Corrupt the header count to claim far more entries than the file holds
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t huge = UINT64_MAX / 2;
+        f.seekp(8);
+        f.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    try {
+        load_hash_trace(path);
+        ADD_FAILURE() << "expected corrupt header to be rejected";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("Truncated hash trace"), std::string::npos) << e.what();
+    }
+    std::remove(path.c_str());
+}
+
+TEST(ReplayTest, HashTraceRoundTripsThroughFile) {
+    auto trace = record_hash_trace(generate_order_flow(1000, 3));
+    const std::string path = "replay_roundtrip_trace.bin";
+    save_hash_trace(path, trace);
+    auto loaded = load_hash_trace(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded, trace);
+}
+
+// --- Memory Accounting & Compaction ---
+
+TEST(LimitOrderBookTest, MemoryUsageTracksLiveOrders) {
+    LimitOrderBook lob(10'000);
+    auto empty = lob.memory_usage();
+    EXPECT_EQ(empty.order_pool.live_bytes, 0u);
+    EXPECT_GE(empty.order_pool.reserved_bytes, 10'000 * sizeof(Order));
+    EXPECT_GE(empty.order_index.reserved_bytes, 100'000 * sizeof(void*)); // up-front reserve
+
+    for (int64_t id = 1; id <= 100; ++id) {
+        lob.process_order(id, 100.00, 10, OrderSide::Buy);
+    }
+    auto filled = lob.memory_usage();
+    EXPECT_EQ(filled.order_pool.live_bytes, 100 * sizeof(Order));
+    EXPECT_GE(filled.price_levels.live_bytes, empty.price_levels.live_bytes + 100 * sizeof(Order*));
+    EXPECT_GT(filled.order_index.live_bytes, 0u);
+    EXPECT_GT(filled.active_levels.live_bytes, 0u);
+    EXPECT_LE(filled.total().live_bytes, filled.total().reserved_bytes);
+}
+
+TEST(LimitOrderBookTest, CompactReleasesIdleLevelStorage) {
+    LimitOrderBook lob(10'000);
+    for (int64_t id = 1; id <= 1000; ++id) {
+        lob.process_order(id, 100.00, 10, OrderSide::Buy);
+    }
+    lob.process_order(2000, 101.00, 10, OrderSide::Sell);
+    for (int64_t id = 1; id <= 1000; ++id) lob.cancel_order(id);
+
+    const auto& levels = lob.get_price_levels();
+    std::size_t idx100 = price_to_index(100.00);
+    std::size_t idx101 = price_to_index(101.00);
+    ASSERT_GE(levels[idx100].orders.capacity(), 1000u);
+    auto before = lob.memory_usage();
+
+    // Cursor starts at level 0, so the first step stops short of 100.00
+    CompactionBudget budget;
+    budget.max_levels = idx100;
+    budget.max_index_rehash = 4'096;
+    lob.compact(budget);
+    EXPECT_GE(levels[idx100].orders.capacity(), 1000u);
+
+    size_t released = lob.compact(budget);
+    EXPECT_EQ(levels[idx100].orders.capacity(), 0u);
+    EXPECT_EQ(levels[idx101].orders.size(), 1u); // live level untouched
+    EXPECT_GE(released, 1000 * sizeof(Order*));
+
+    auto after = lob.memory_usage();
+    EXPECT_LT(after.price_levels.reserved_bytes, before.price_levels.reserved_bytes);
+    EXPECT_LT(after.order_index.reserved_bytes, before.order_index.reserved_bytes);
+    EXPECT_EQ(after.total().live_bytes, before.total().live_bytes);
+
+    // Released level is usable again
+    lob.process_order(3000, 100.00, 5, OrderSide::Buy);
+    EXPECT_EQ(levels[idx100].total_quantity, 5);
+}
+
+TEST(LimitOrderBookTest, DefaultCompactionKeepsIndexReserve) {
+    LimitOrderBook lob(10'000);
+    lob.process_order(1, 100.00, 10, OrderSide::Buy);
+    size_t buckets = lob.orders_by_id.bucket_count();
+    ASSERT_GE(buckets, 100'000u);
+
+    CompactionBudget budget;
+    budget.max_levels = SIZE_MAX;
+    lob.compact(budget);
+    EXPECT_EQ(lob.orders_by_id.bucket_count(), buckets);
+}
+
+TEST(MemoryPoolTest, ReleasesOnlyIdleChunks) {
+    MemoryPool<Order> pool(4096 * 8);
+    std::vector<Order*> live;
+    for (int i = 0; i < 4096; ++i) live.push_back(pool.allocate());
+    for (auto* o : live) *o = Order{1, 100, 10, OrderSide::Buy};
+
+    auto before = pool.memory_usage();
+    size_t released = 0;
+    for (int step = 0; step < 8; ++step) released += pool.release_idle_chunks(1);
+    auto after = pool.memory_usage();
+
+    EXPECT_GT(released, 0u);
+    EXPECT_EQ(pool.in_use(), 4096u);
+    EXPECT_EQ(after.live_bytes, before.live_bytes);
+    EXPECT_EQ(before.reserved_bytes - after.reserved_bytes, released);
+    for (auto* o : live) EXPECT_EQ(o->quantity, 10); // live chunk kept intact
+
+    // Released slots are handed out again transparently
+    for (auto* o : live) pool.deallocate(o);
+    for (int i = 0; i < 4096 * 8; ++i) {
+        Order* o = pool.allocate();
+        *o = Order{i, 100, 1, OrderSide::Sell};
+    }
+    EXPECT_EQ(pool.in_use(), 4096u * 8);
+    EXPECT_THROW(pool.allocate(), std::runtime_error);
+}
+
+TEST(MemoryPoolTest, IdlePoolReleasesFreeListStorage) {
+    MemoryPool<Order> pool(1'000'000);
+    std::vector<Order*> burst;
+    for (int i = 0; i < 500'000; ++i) burst.push_back(pool.allocate());
+    for (auto* o : burst) pool.deallocate(o);
+    auto idle = pool.memory_usage();
+    EXPECT_GT(idle.reserved_bytes, 1'000'000 * sizeof(Order)); // slots + chunk headers
+
+    pool.release_idle_chunks(SIZE_MAX);
+    auto released = pool.memory_usage();
+    EXPECT_EQ(released.live_bytes, 0u);
+    // Only per-chunk headers stay resident: well under 1% of the slot storage
+    EXPECT_LT(released.reserved_bytes, 1'000'000 * sizeof(Order) / 100);
+}
+
+TEST(MemoryPoolTest, PrefersResidentChunksOverReleasedOnes) {
+    MemoryPool<Order> pool(4096 * 3);
+    std::vector<Order*> slots;
+    for (int i = 0; i < 4096 * 2; ++i) slots.push_back(pool.allocate()); // chunks 0 and 1 full
+
+    Order* resident_free = slots[10];
+    pool.deallocate(resident_free);                              // chunk 0: one free slot
+    for (int i = 4096; i < 4096 * 2; ++i) pool.deallocate(slots[i]); // chunk 1: idle, listed last
+    ASSERT_GT(pool.release_idle_chunks(SIZE_MAX), 0u);           // releases chunks 1 and 2
+
+    EXPECT_EQ(pool.allocate(), resident_free);
+    auto before = pool.memory_usage();
+    Order* fallback = pool.allocate(); // chunk 0 full -> only now reuse a released chunk
+    EXPECT_TRUE(fallback < slots[0] || fallback >= slots[0] + 4096);
+    EXPECT_GT(pool.memory_usage().reserved_bytes, before.reserved_bytes);
+}
+
+TEST(ReplayTest, CompactionDoesNotChangeMatchingOutput) {
+    auto events = generate_order_flow(50'000);
+    auto trace = record_hash_trace(events);
+
+    LimitOrderBook lob(events.size());
+    CompactionBudget budget;
+    budget.max_index_rehash = events.size();
+    for (size_t i = 0; i < events.size(); ++i) {
+        apply_event(lob, events[i]);
+        if (i % 500 == 0) lob.compact(budget);
+        ASSERT_EQ(lob.get_state_hash(), trace[i]) << " at event " << i;
+    }
+}
+
+// --- Backtesting ---
+
+TEST(BacktestTest, OrderFlowRoundTripsThroughFile) {
+    auto events = generate_order_flow(1000, 7);
+    const std::string path = "backtest_roundtrip_flow.csv";
+    save_order_flow(path, events);
+    auto loaded = load_order_flow(path);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(loaded.size(), events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_EQ(loaded[i].type, events[i].type) << " at event " << i;
+        EXPECT_EQ(loaded[i].order_id, events[i].order_id) << " at event " << i;
+        if (events[i].type == EventType::Add) {
+            EXPECT_EQ(loaded[i].price, events[i].price) << " at event " << i;
+            EXPECT_EQ(loaded[i].side, events[i].side) << " at event " << i;
+        }
+        if (events[i].type != EventType::Cancel) {
+            EXPECT_EQ(loaded[i].quantity, events[i].quantity) << " at event " << i;
+        }
+    }
+}
+
+TEST(BacktestTest, OrderFlowRejectsOutOfLadderPrice) {
+    const std::string path = "backtest_bad_price_flow.csv";
+    {
+        std::ofstream out(path);
+        out << "A,1,100,10,B\n# comment\nA,2,900,10,S\n";
+    }
+    try {
+        load_order_flow(path);
+        ADD_FAILURE() << "expected out-of-ladder price to be rejected";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find(path + ":3"), std::string::npos) << e.what();
+    }
+    std::remove(path.c_str());
+}
+
+TEST(BacktestTest, RunMatchesSequentialReplay) {
+    auto events = generate_order_flow(20'000);
+
+    LimitOrderBook reference;
+    for (const auto& ev : events) apply_event(reference, ev);
+
+    BacktestRunner runner(2, 100'000);
+    auto report = runner.run(events, {{"replay", nullptr}, {"replay-again", nullptr}});
+
+    ASSERT_EQ(report.runs.size(), 2u);
+    for (const auto& r : report.runs) {
+        EXPECT_EQ(r.fills.fill_count, reference.get_fill_stats().fill_count);
+        EXPECT_EQ(r.fills.filled_quantity, reference.get_fill_stats().filled_quantity);
+        EXPECT_EQ(r.fills.filled_notional, reference.get_fill_stats().filled_notional);
+        EXPECT_EQ(r.resting_orders, reference.resting_order_count());
+        EXPECT_EQ(r.state_hash, reference.get_state_hash());
+    }
+}
+
+TEST(BacktestTest, ResultsIndependentOfThreadCount) {
+    auto events = generate_order_flow(20'000);
+
+    std::vector<BacktestVariant> variants;
+    for (int k = 0; k < 12; ++k) {
+        int32_t qty = 10 * (k + 1);
+        variants.push_back({"taker-" + std::to_string(k),
+            [qty](LimitOrderBook& lob, const OrderEvent&, size_t event_idx) {
+                if (event_idx % 100 != 0) return;
+                int64_t id = 1'000'000'000 + static_cast<int64_t>(event_idx);
+                lob.process_order(id, 110, qty, OrderSide::Buy);
+                lob.cancel_order(id);
+            }});
+    }
+
+    auto single = BacktestRunner(1, 100'000).run(events, variants);
+    auto multi = BacktestRunner(4, 100'000).run(events, variants);
+
+    ASSERT_EQ(single.runs.size(), variants.size());
+    ASSERT_EQ(multi.runs.size(), variants.size());
+    for (size_t i = 0; i < variants.size(); ++i) {
+        EXPECT_EQ(multi.runs[i].name, variants[i].name);
+        EXPECT_EQ(multi.runs[i].fills.fill_count, single.runs[i].fills.fill_count);
+        EXPECT_EQ(multi.runs[i].fills.filled_quantity, single.runs[i].fills.filled_quantity);
+        EXPECT_EQ(multi.runs[i].fills.filled_notional, single.runs[i].fills.filled_notional);
+        EXPECT_EQ(multi.runs[i].resting_orders, single.runs[i].resting_orders);
+        EXPECT_EQ(multi.runs[i].state_hash, single.runs[i].state_hash);
+    }
+    // Bigger taker orders must trade at least as much as smaller ones
+    EXPECT_GT(single.runs.back().fills.filled_quantity, single.runs.front().fills.filled_quantity);
+}
+
 // --- Stress Testing ---
 
 TEST(LimitOrderBookStressTest, RandomizedOperationsWithTiming) {